@@ -21,12 +21,32 @@ extern "C" {
 #define MGL_SH1106_LOW_COLUMN_ADDRESS _u(0x02)
 #define MGL_SH1106_HIGH_COLUMN_ADDRESS _u(0x10)
 #define MGL_SH1106_SET_PAGE_ADDRESS _u(0xB0)
+#define MGL_SH1106_SET_DISPLAY_OFFSET _u(0xd3)
+// The visible columns start at column 2 of the 132 columns of display RAM
+#define MGL_SH1106_COLUMN_OFFSET _u(2)
+
+// Maximum amount of chars of a mgl_text_field
+#define MGL_TEXT_FIELD_MAX_CELLS 32
+// Maximum amount of pending commands of mgl_effects
+#define MGL_EFFECTS_MAX_COMMANDS 32
 
 // Every avalible core type
 typedef enum _mgl_display_core_ {
     MGL_DISPLAY_CORE_SH1106
 } mgl_display_core;
 
+/**
+ *  Orientation of the image on the display (clockwise rotation).
+ *  For 90 and 270 degrees the framebuffer is in portrait layout,
+ *  width and height of the display are swapped.
+ */
+typedef enum _mgl_display_orientation_ {
+    MGL_ORIENTATION_0,
+    MGL_ORIENTATION_90,
+    MGL_ORIENTATION_180,
+    MGL_ORIENTATION_270
+} mgl_display_orientation;
+
 /**
  *  The majority of elements must be provided by yourself.
  *  For example:
@@ -64,8 +84,135 @@ typedef struct _mgl_display_ {
      *       you may want to handle allocation by yourself
      */
     uint8_t* framebuffer;
+
+    /**
+     *  Orientation of the display
+     *  NOTE: Use mgl_display_set_orientation to change these
+     */
+    mgl_display_orientation orientation;
+    bool mirrored;
 } mgl_display;
 
+/**
+ *  An offscreen surface is a display without a panel attached.
+ *  It uses the same packed page layout as the display framebuffer,
+ *  so every drawing function (mgl_display_draw_...) works on it as well.
+ *  Only width, height and (optionally) framebuffer need to be provided:
+ *      mgl_surface chrome = {
+ *          .width = 128,
+ *          .height = 64,
+ *          .framebuffer = NULL
+ *      };
+ *      mgl_surface_init(&chrome);
+ */
+typedef mgl_display mgl_surface;
+
+// How a surface is combined with the display framebuffer
+typedef enum _mgl_compose_mode_ {
+    // Overwrite the covered area with the surface
+    MGL_COMPOSE_COPY,
+    // Only set pixels, leave the covered area as it is otherwise
+    MGL_COMPOSE_OR
+} mgl_compose_mode;
+
+/**
+ *  A text field is a fixed row of 8x8 cells at x|y.
+ *  It remembers the chars it has drawn, setting a new text only rasterizes
+ *  the cells whose char changed and marks them dirty,
+ *  mgl_text_field_render then transmits only the dirty cells.
+ *  For example:
+ *      mgl_text_field temp;
+ *      mgl_text_field_init(&disp, &temp, 0, 16, 6);
+ *      mgl_text_field_set_fixed(&disp, &temp, 234, 1, " C");    <-- " 23.4 C"
+ *      mgl_text_field_render(&disp, &temp);
+ */
+typedef struct _mgl_text_field_ {
+    uint32_t x;
+    uint32_t y;
+    // Amount of cells (chars), up to MGL_TEXT_FIELD_MAX_CELLS
+    uint8_t cells;
+    // The chars currently drawn into the framebuffer
+    char text[MGL_TEXT_FIELD_MAX_CELLS];
+    // Bit i is set if cell i was changed since the last mgl_text_field_render
+    uint32_t dirty;
+} mgl_text_field;
+
+/**
+ *  A strip chart plots the last "width" samples of a stream, one column per sample.
+ *  Pushing a sample scrolls the chart area of the framebuffer one column to the left
+ *  and only draws the new column.
+ *  For example:
+ *      mgl_strip_chart chart = {
+ *          .x = 0,
+ *          .y = 16,
+ *          .width = 128,
+ *          .height = 48,
+ *          .min = 0,
+ *          .max = 1023,
+ *          .samples = NULL     <-- You may also allocate "width" samples by yourself
+ *      };
+ *      mgl_strip_chart_init(&disp, &chart);
+ *      mgl_strip_chart_push(&disp, &chart, adc_value);
+ *      mgl_strip_chart_render(&disp, &chart);
+ */
+typedef struct _mgl_strip_chart_ {
+    // Area of the chart (in pixel)
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+
+    // Values are clamped to this range, min is drawn at the bottom of the chart
+    int32_t min;
+    int32_t max;
+
+    /**
+     *  Ring buffer of "width" samples
+     *  NOTE: mgl_strip_chart_init will only allocate this if it is NULL
+     */
+    int32_t* samples;
+    // Index of the next sample in the ring buffer
+    uint32_t head;
+    // Amount of samples in the ring buffer
+    uint32_t count;
+} mgl_strip_chart;
+
+// Panel commands that can be scheduled by mgl_effects
+typedef enum _mgl_effect_action_ {
+    // mgl_display_set_state
+    MGL_EFFECT_STATE,
+    // mgl_display_set_inverted
+    MGL_EFFECT_INVERT,
+    // mgl_display_set_contrast
+    MGL_EFFECT_CONTRAST,
+    // mgl_display_set_offset
+    MGL_EFFECT_OFFSET
+} mgl_effect_action;
+
+typedef struct _mgl_effect_command_ {
+    uint32_t due_ms;
+    // The command is repeated every period_ms, 0 means only once
+    uint32_t period_ms;
+    mgl_effect_action action;
+    uint8_t value;
+} mgl_effect_command;
+
+/**
+ *  Display effects (blinking, fading, ...) are made of panel commands
+ *  sent at the right time, the framebuffer is never touched or transmitted.
+ *  There is no clock in microgl, the current time (in milliseconds) is passed by yourself.
+ *  For example:
+ *      mgl_effects effects = {0};
+ *      mgl_effects_blink(&effects, now_ms(), 500, true);
+ *      while (1) {
+ *          mgl_effects_update(&disp, &effects, now_ms());
+ *      }
+ */
+typedef struct _mgl_effects_ {
+    mgl_effect_command commands[MGL_EFFECTS_MAX_COMMANDS];
+    uint8_t count;
+} mgl_effects;
+
 /**
  *  mgl_display_write_cmd
  * 
@@ -94,6 +241,33 @@ bool mgl_display_init(mgl_display* display);
  */
 void mgl_display_destroy(mgl_display* display);
 
+/**
+ *  mgl_display_get_framebuffer_size
+ *
+ *  @brief Get the size of the framebuffer (in bytes) needed by the display or surface provided.
+ *  NOTE: Every byte holds 8 vertical pixels, the framebuffer is made of height/8 pages of width bytes each.
+ */
+uint32_t mgl_display_get_framebuffer_size(mgl_display* display);
+
+/**
+ *  mgl_surface_init
+ *
+ *  @brief Initialize an offscreen surface.
+ *         Unlike mgl_display_init, this will not touch any i2c device.
+ *  Return value:
+ *      true -- success
+ *      false -- failure (no memory or provided surface is NULL)
+ */
+bool mgl_surface_init(mgl_surface* surface);
+
+/**
+ *  mgl_surface_destroy
+ *
+ *  @brief Destroy an existing surface
+ *  NOTE: The framebuffer will be free'd and set to NULL, not the pointer to the surface.
+ */
+void mgl_surface_destroy(mgl_surface* surface);
+
 /**
  *  mgl_display_set_state
  * 
@@ -101,6 +275,41 @@ void mgl_display_destroy(mgl_display* display);
  */
 void mgl_display_set_state(mgl_display* display, bool enabled);
 
+/**
+ *  mgl_display_set_inverted
+ *
+ *  @brief Let the display invert every pixel, the framebuffer is not changed
+ */
+void mgl_display_set_inverted(mgl_display* display, bool inverted);
+
+/**
+ *  mgl_display_set_contrast
+ *
+ *  @brief Set the contrast (brightness) of the display
+ */
+void mgl_display_set_contrast(mgl_display* display, uint8_t contrast);
+
+/**
+ *  mgl_display_set_offset
+ *
+ *  @brief Let the display shift the image up by "offset" rows (wrapping around)
+ */
+void mgl_display_set_offset(mgl_display* display, uint8_t offset);
+
+/**
+ *  mgl_display_set_orientation
+ *
+ *  @brief Rotate the display by "orientation" and mirror it horizontally if "mirrored" is set
+ *  NOTE: 0 and 180 degrees as well as mirroring are done by the display and cost nothing.
+ *        90 and 270 degrees swap width and height of the display,
+ *        the framebuffer is then rotated in 8x8 blocks while rendering.
+ *        Switching between landscape and portrait clears the framebuffer.
+ *  Return value:
+ *      true -- success
+ *      false -- failure (unknown core, or portrait dimensions are not multiples of 8)
+ */
+bool mgl_display_set_orientation(mgl_display* display, mgl_display_orientation orientation, bool mirrored);
+
 /**
  *  mgl_display_render
  * 
@@ -108,6 +317,15 @@ void mgl_display_set_state(mgl_display* display, bool enabled);
  */
 void mgl_display_render(mgl_display* display);
 
+/**
+ *  mgl_display_render_area
+ *
+ *  @brief Render only the pixels of the framebuffer inside the provided area onto the screen
+ *  NOTE: Whole pages (8 pixel rows) are transmitted,
+ *        so the area is extended to the pages it touches.
+ */
+void mgl_display_render_area(mgl_display* display, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
 /**
  *  mgl_display_draw_pixel
  *  
@@ -170,6 +388,153 @@ void mgl_display_draw_char(mgl_display* display, uint32_t x, uint32_t y, char c)
  */
 void mgl_display_draw_string(mgl_display* display, uint32_t x, uint32_t y, const char* str);
 
+/**
+ *  mgl_display_compose
+ *
+ *  @brief Compose a surface onto the framebuffer at x|y
+ *  NOTE: Composing at a y that is a multiple of 8 copies whole pages (memcpy),
+ *        any other y shifts every byte across two pages.
+ *        The surface is clipped at the edges of the display.
+ *
+ *        Call mgl_display_render in order to make changes visible on the display.
+ */
+void mgl_display_compose(mgl_display* display, mgl_surface* surface, uint32_t x, uint32_t y, mgl_compose_mode mode);
+
+/**
+ *  mgl_text_field_init
+ *
+ *  @brief Initialize a text field of "cells" chars at x|y and clear its area in the framebuffer
+ */
+void mgl_text_field_init(mgl_display* display, mgl_text_field* field, uint32_t x, uint32_t y, uint8_t cells);
+
+/**
+ *  mgl_text_field_set_string
+ *
+ *  @brief Set the text of the field (left-aligned), only changed cells are drawn
+ *  NOTE: Chars that do not fit into the field are ignored.
+ */
+void mgl_text_field_set_string(mgl_display* display, mgl_text_field* field, const char* str);
+
+/**
+ *  mgl_text_field_set_int
+ *
+ *  @brief Set the text of the field to value followed by suffix (may be NULL), right-aligned
+ *  NOTE: The field is filled with '#' if the text does not fit.
+ */
+void mgl_text_field_set_int(mgl_display* display, mgl_text_field* field, int32_t value, const char* suffix);
+
+/**
+ *  mgl_text_field_set_fixed
+ *
+ *  @brief Same as mgl_text_field_set_int, but the last "decimals" digits of value are decimal places
+ *         (e.g. value = 234 and decimals = 1 results in "23.4")
+ */
+void mgl_text_field_set_fixed(mgl_display* display, mgl_text_field* field, int32_t value, uint8_t decimals, const char* suffix);
+
+/**
+ *  mgl_text_field_render
+ *
+ *  @brief Transmit the cells of the field that changed since the last call
+ */
+void mgl_text_field_render(mgl_display* display, mgl_text_field* field);
+
+/**
+ *  mgl_strip_chart_init
+ *
+ *  @brief Initialize the strip chart provided and clear its area in the framebuffer
+ *  Return value:
+ *      true -- success
+ *      false -- failure (area does not fit the display, min >= max or no memory)
+ */
+bool mgl_strip_chart_init(mgl_display* display, mgl_strip_chart* chart);
+
+/**
+ *  mgl_strip_chart_destroy
+ *
+ *  @brief Destroy an existing strip chart
+ *  NOTE: The samples will be free'd and set to NULL, not the pointer to the chart.
+ */
+void mgl_strip_chart_destroy(mgl_strip_chart* chart);
+
+/**
+ *  mgl_strip_chart_push
+ *
+ *  @brief Append a sample, the chart is scrolled in place and only the new column is drawn
+ */
+void mgl_strip_chart_push(mgl_display* display, mgl_strip_chart* chart, int32_t value);
+
+/**
+ *  mgl_strip_chart_redraw
+ *
+ *  @brief Draw the whole chart from its samples, e.g. after the framebuffer was cleared
+ */
+void mgl_strip_chart_redraw(mgl_display* display, mgl_strip_chart* chart);
+
+/**
+ *  mgl_strip_chart_render
+ *
+ *  @brief Transmit only the area of the chart
+ */
+void mgl_strip_chart_render(mgl_display* display, mgl_strip_chart* chart);
+
+/**
+ *  mgl_effects_schedule
+ *
+ *  @brief Schedule a panel command at due_ms, repeated every period_ms (0 means only once)
+ *  Return value:
+ *      true -- success
+ *      false -- failure (MGL_EFFECTS_MAX_COMMANDS commands are already pending)
+ */
+bool mgl_effects_schedule(mgl_effects* effects, uint32_t due_ms, uint32_t period_ms, mgl_effect_action action, uint8_t value);
+
+/**
+ *  mgl_effects_update
+ *
+ *  @brief Send every command that is due at now_ms, call this regularly
+ *  Return value:
+ *      Amount of commands sent
+ */
+uint32_t mgl_effects_update(mgl_display* display, mgl_effects* effects, uint32_t now_ms);
+
+/**
+ *  mgl_effects_stop
+ *
+ *  @brief Drop every pending command, then enable the display, disable inversion and reset the offset
+ *  NOTE: The contrast is left as it is.
+ */
+void mgl_effects_stop(mgl_display* display, mgl_effects* effects);
+
+/**
+ *  mgl_effects_blink
+ *
+ *  @brief Blink until mgl_effects_stop, switching every interval_ms.
+ *         Blinking inverts the display if "invert" is set, otherwise it is turned off and on.
+ *  Return value:
+ *      true -- success
+ *      false -- failure (interval_ms is 0 or too many commands are pending)
+ */
+bool mgl_effects_blink(mgl_effects* effects, uint32_t now_ms, uint32_t interval_ms, bool invert);
+
+/**
+ *  mgl_effects_fade
+ *
+ *  @brief Fade the contrast from "from" to "to" in "steps" steps over duration_ms
+ *  Return value:
+ *      true -- success
+ *      false -- failure (steps is 0 or too many commands are pending)
+ */
+bool mgl_effects_fade(mgl_effects* effects, uint32_t now_ms, uint8_t from, uint8_t to, uint32_t duration_ms, uint8_t steps);
+
+/**
+ *  mgl_effects_shake
+ *
+ *  @brief Shake the image up and down by "amplitude" rows "count" times, every interval_ms
+ *  Return value:
+ *      true -- success
+ *      false -- failure (amplitude is 0 or >= 32, count is 0 or too many commands are pending)
+ */
+bool mgl_effects_shake(mgl_effects* effects, uint32_t now_ms, uint8_t amplitude, uint32_t interval_ms, uint8_t count);
+
 #ifdef __cplusplus
 }
 #endif
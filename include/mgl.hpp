@@ -0,0 +1,288 @@
+/**
+ *  mgl.hpp
+ *  @brief Header-only C++ interface of microgl.
+ *         The display dimensions are template parameters, which makes strides and
+ *         bounds compile-time constants and lets the framebuffer live in a std::array.
+ *         Rendering is still done by the C implementation (mgl.h),
+ *         existing C users are not affected by this header in any way.
+ */
+#ifndef MICROGL_HPP
+#define MICROGL_HPP
+
+#if __cplusplus < 201703L
+#error "mgl.hpp requires C++17 or newer"
+#endif
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "mgl.h"
+#include "mgl_font.h"
+
+namespace mgl {
+
+namespace detail {
+
+inline constexpr uint8_t default_font[128][8] = MGL_DEFAULT_FONT;
+
+/**
+ *  The default font stored column by column (bit i of column j is the pixel at j|i),
+ *  which is the layout of a framebuffer page.
+ *  Transposed once at compile time, drawing a char is then a matter of 8 byte writes.
+ */
+constexpr std::array<std::array<uint8_t, 8>, 128> transpose_font() {
+    std::array<std::array<uint8_t, 8>, 128> columns{};
+    for (std::size_t c = 0; c < 128; ++c) {
+        for (uint8_t j = 0; j < 8; ++j) {
+            uint8_t column = 0;
+            for (uint8_t i = 0; i < 8; ++i) {
+                column |= ((default_font[c][i] >> j) & 1) << i;
+            }
+            columns[c][j] = column;
+        }
+    }
+    return columns;
+}
+
+inline constexpr std::array<std::array<uint8_t, 8>, 128> font_columns = transpose_font();
+
+} // namespace detail
+
+/**
+ *  For example:
+ *  main.cpp
+ *      mgl::Display<MGL_DISPLAY_CORE_SH1106, 128, 64> disp(0, 1);
+ *      disp.init();
+ *      disp.draw_string(32, 16, "microgl");
+ *      disp.render();
+ */
+template <mgl_display_core Core, uint32_t Width, uint32_t Height>
+class Display {
+    static_assert(Width > 0 && Height > 0, "Display dimensions must not be zero");
+
+public:
+    static constexpr mgl_display_core core = Core;
+    static constexpr uint32_t width = Width;
+    static constexpr uint32_t height = Height;
+    static constexpr uint32_t pages = (Height + 7) / 8;
+
+    using Framebuffer = std::array<uint8_t, Width * pages>;
+
+    constexpr Display() = default;
+
+    constexpr Display(uint8_t sda_pin, uint8_t scl_pin, uint8_t i2c_address = 0x3c, uint32_t i2c_baudrate = 400000)
+        : sda_pin_(sda_pin), scl_pin_(scl_pin), i2c_address_(i2c_address), i2c_baudrate_(i2c_baudrate) {}
+
+    /**
+     *  init
+     *
+     *  @brief Initialize i2c and the display, see mgl_display_init
+     */
+    bool init() {
+        mgl_display display = c_display();
+        return mgl_display_init(&display);
+    }
+
+    /**
+     *  destroy
+     *
+     *  @brief Disable the display
+     *  NOTE: Unlike mgl_display_destroy, there is nothing to free.
+     */
+    void destroy() {
+        set_state(false);
+    }
+
+    void set_state(bool enabled) {
+        mgl_display display = c_display();
+        mgl_display_set_state(&display, enabled);
+    }
+
+    /**
+     *  render
+     *
+     *  @brief Render the pixels from the framebuffer onto the screen
+     */
+    void render() {
+        mgl_display display = c_display();
+        mgl_display_render(&display);
+    }
+
+    /**
+     *  c_display
+     *
+     *  @brief Get a C view of this display
+     *  NOTE: The view points to the framebuffer of this object,
+     *        never pass it to mgl_display_destroy.
+     */
+    mgl_display c_display() {
+        mgl_display display{};
+        display.core = Core;
+        display.sda_pin = sda_pin_;
+        display.scl_pin = scl_pin_;
+        display.i2c_address = i2c_address_;
+        display.i2c_baudrate = i2c_baudrate_;
+        display.width = Width;
+        display.height = Height;
+        display.framebuffer = framebuffer_.data();
+        return display;
+    }
+
+    constexpr Framebuffer& framebuffer() { return framebuffer_; }
+    constexpr const Framebuffer& framebuffer() const { return framebuffer_; }
+
+    /**
+     *  draw_pixel
+     *
+     *  @brief Draw a pixel into the framebuffer
+     *  NOTE: Any drawing function (draw_...)
+     *        will simply change memory of the framebuffer.
+     *        Call render in order to make such changes visible on the display.
+     */
+    constexpr void draw_pixel(uint32_t x, uint32_t y) {
+        if (x >= Width || y >= Height) {
+            return;
+        }
+        framebuffer_[x + (y / 8) * Width] |= 1 << (y % 8);
+    }
+
+    /**
+     *  draw_pixel<X, Y>
+     *
+     *  @brief Draw a pixel at a position known at compile time, there is no runtime check at all
+     */
+    template <uint32_t X, uint32_t Y>
+    constexpr void draw_pixel() {
+        static_assert(X < Width && Y < Height, "Pixel is out of bounds");
+        framebuffer_[X + (Y / 8) * Width] |= 1 << (Y % 8);
+    }
+
+    /**
+     *  draw_line
+     *
+     *  @brief Draw a line into the framebuffer
+     */
+    constexpr void draw_line(uint32_t from_x, uint32_t from_y, uint32_t to_x, uint32_t to_y) {
+        if (from_x >= Width || from_y >= Height || to_x >= Width || to_y >= Height) {
+            return;
+        }
+
+        // Bresenham's line algorithm (https://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm)
+        int32_t dx = to_x > from_x ? to_x - from_x : from_x - to_x;
+        int32_t sx = from_x < to_x ? 1 : -1;
+        int32_t dy = -(int32_t)(to_y > from_y ? to_y - from_y : from_y - to_y);
+        int32_t sy = from_y < to_y ? 1 : -1;
+        int32_t error = dx + dy;
+
+        while (true) {
+            // Both endpoints are in bounds, so is every point in between
+            framebuffer_[from_x + (from_y / 8) * Width] |= 1 << (from_y % 8);
+            if (from_x == to_x && from_y == to_y) {
+                break;
+            }
+            int32_t e2 = 2 * error;
+            if (e2 >= dy) {
+                error += dy;
+                from_x += sx;
+            }
+            if (e2 <= dx) {
+                error += dx;
+                from_y += sy;
+            }
+        }
+    }
+
+    /**
+     *  draw_rect
+     *
+     *  @brief Draw a rectangle into the framebuffer
+     *  NOTE: Same as mgl_display_draw_rect, the rectangle spans from x|y to x+width|y+height (inclusive).
+     */
+    constexpr void draw_rect(uint32_t x, uint32_t y, uint32_t width, uint32_t height, bool fill) {
+        if (x >= Width || y >= Height || width >= Width - x || height >= Height - y) {
+            return;
+        }
+
+        if (fill) {
+            for (uint32_t j = y; j <= y + height; ++j) {
+                uint8_t bit = 1 << (j % 8);
+                uint8_t* row = &framebuffer_[(j / 8) * Width];
+                for (uint32_t i = x; i <= x + width; ++i) {
+                    row[i] |= bit;
+                }
+            }
+        } else {
+            for (uint32_t i = x; i <= x + width; ++i) {
+                draw_pixel(i, y);
+                draw_pixel(i, y + height);
+            }
+            for (uint32_t j = y; j <= y + height; ++j) {
+                draw_pixel(x, j);
+                draw_pixel(x + width, j);
+            }
+        }
+    }
+
+    /**
+     *  fill
+     *
+     *  @brief Fill the entire framebuffer with "value"
+     */
+    constexpr void fill(uint8_t value) {
+        for (uint8_t& byte : framebuffer_) {
+            byte = value;
+        }
+    }
+
+    /**
+     *  draw_char
+     *
+     *  @brief Draw a char into the framebuffer
+     *  NOTE: A y that is a multiple of 8 writes the glyph into a single page.
+     */
+    constexpr void draw_char(uint32_t x, uint32_t y, char c) {
+        if (x >= Width || y >= Height) {
+            return;
+        }
+
+        const std::array<uint8_t, 8>& glyph = detail::font_columns[(uint8_t)c & 0x7F];
+        uint32_t page = y / 8;
+        uint8_t shift = y % 8;
+        uint32_t columns = Width - x < 8 ? Width - x : 8;
+        for (uint32_t j = 0; j < columns; ++j) {
+            framebuffer_[x + j + page * Width] |= glyph[j] << shift;
+            if (shift && page + 1 < pages) {
+                framebuffer_[x + j + (page + 1) * Width] |= glyph[j] >> (8 - shift);
+            }
+        }
+    }
+
+    /**
+     *  draw_string
+     *
+     *  @brief Draw a string into the framebuffer
+     *  NOTE: Same as mgl_display_draw_string, only the first 128 bytes are rendered.
+     */
+    constexpr void draw_string(uint32_t x, uint32_t y, const char* str) {
+        if (!str) {
+            return;
+        }
+        for (uint32_t i = 0; i < 128 && str[i] && x + i * 8 < Width; ++i) {
+            draw_char(x + i * 8, y, str[i]);
+        }
+    }
+
+private:
+    uint8_t sda_pin_ = 0;
+    uint8_t scl_pin_ = 0;
+    // Many displays use 0x3c
+    uint8_t i2c_address_ = 0x3c;
+    uint32_t i2c_baudrate_ = 400000;
+
+    Framebuffer framebuffer_{};
+};
+
+} // namespace mgl
+
+#endif // !MICROGL_HPP
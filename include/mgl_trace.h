@@ -0,0 +1,55 @@
+/**
+ *  mgl_trace.h
+ *  @brief Binary format of the i2c traces recorded by the "capture" platform
+ *         and read back by mgl-replay.
+ *
+ *  A trace file is a mgl_trace_header followed by a ring of "capacity" bytes.
+ *  The ring holds records, every record is a mgl_trace_record directly followed by
+ *  "length" bytes of data. Records may wrap around the end of the ring.
+ *  head and tail count bytes since the start of the capture (they never wrap),
+ *  the ring offset of a position is position % capacity.
+ *  Once the ring is full, the oldest records are dropped.
+ *  All values are stored in the byte order of the capturing device.
+ */
+#ifndef MGL_TRACE_H
+#define MGL_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define MGL_TRACE_MAGIC "MGLT"
+#define MGL_TRACE_VERSION 1
+
+typedef struct _mgl_trace_header_ {
+    char magic[4];
+    uint32_t version;
+    // Baudrate passed to mgl_platform_i2c_init (0 if unknown)
+    uint32_t baudrate;
+    uint32_t reserved;
+    // Size of the ring (in bytes)
+    uint64_t capacity;
+    // Position of the next record to be written
+    uint64_t head;
+    // Position of the oldest record
+    uint64_t tail;
+    // Number of records that were overwritten or did not fit at all
+    uint64_t dropped;
+} mgl_trace_header;
+
+typedef struct _mgl_trace_record_ {
+    // Microseconds since the start of the capture, wraps after ~71 minutes
+    uint32_t timestamp_us;
+    // Amount of data bytes following this record
+    uint16_t length;
+    // i2c address the data was written to
+    uint8_t addr;
+    uint8_t reserved;
+} mgl_trace_record;
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !MGL_TRACE_H
@@ -4,142 +4,14 @@
  *         It aims to provide access to different displays, such as, for example sh1106 based displays.
  */
 #include "mgl.h"
+#include "mgl_font.h"
 
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
-static const uint8_t default_font[128][8] = {
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0000 (nul)
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0001
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0002
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0003
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0004
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0005
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0006
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0007
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0008
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0009
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+000A
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+000B
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+000C
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+000D
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+000E
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+000F
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0010
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0011
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0012
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0013
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0014
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0015
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0016
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0017
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0018
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0019
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+001A
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+001B
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+001C
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+001D
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+001E
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+001F
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0020 (space)
-    { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 },   // U+0021 (!)
-    { 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0022 (")
-    { 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 },   // U+0023 (#)
-    { 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 },   // U+0024 ($)
-    { 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 },   // U+0025 (%)
-    { 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 },   // U+0026 (&)
-    { 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0027 (')
-    { 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 },   // U+0028 (()
-    { 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 },   // U+0029 ())
-    { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 },   // U+002A (*)
-    { 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 },   // U+002B (+)
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 },   // U+002C (,)
-    { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 },   // U+002D (-)
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 },   // U+002E (.)
-    { 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 },   // U+002F (/)
-    { 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 },   // U+0030 (0)
-    { 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 },   // U+0031 (1)
-    { 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 },   // U+0032 (2)
-    { 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 },   // U+0033 (3)
-    { 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 },   // U+0034 (4)
-    { 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 },   // U+0035 (5)
-    { 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 },   // U+0036 (6)
-    { 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 },   // U+0037 (7)
-    { 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 },   // U+0038 (8)
-    { 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 },   // U+0039 (9)
-    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 },   // U+003A (:)
-    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 },   // U+003B (;)
-    { 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 },   // U+003C (<)
-    { 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 },   // U+003D (=)
-    { 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 },   // U+003E (>)
-    { 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 },   // U+003F (?)
-    { 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 },   // U+0040 (@)
-    { 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 },   // U+0041 (A)
-    { 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 },   // U+0042 (B)
-    { 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 },   // U+0043 (C)
-    { 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 },   // U+0044 (D)
-    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 },   // U+0045 (E)
-    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 },   // U+0046 (F)
-    { 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 },   // U+0047 (G)
-    { 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 },   // U+0048 (H)
-    { 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },   // U+0049 (I)
-    { 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 },   // U+004A (J)
-    { 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 },   // U+004B (K)
-    { 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 },   // U+004C (L)
-    { 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 },   // U+004D (M)
-    { 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 },   // U+004E (N)
-    { 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 },   // U+004F (O)
-    { 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 },   // U+0050 (P)
-    { 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 },   // U+0051 (Q)
-    { 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 },   // U+0052 (R)
-    { 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 },   // U+0053 (S)
-    { 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },   // U+0054 (T)
-    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 },   // U+0055 (U)
-    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },   // U+0056 (V)
-    { 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 },   // U+0057 (W)
-    { 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 },   // U+0058 (X)
-    { 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 },   // U+0059 (Y)
-    { 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 },   // U+005A (Z)
-    { 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 },   // U+005B ([)
-    { 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 },   // U+005C (\)
-    { 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 },   // U+005D (])
-    { 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 },   // U+005E (^)
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF },   // U+005F (_)
-    { 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+0060 (`)
-    { 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 },   // U+0061 (a)
-    { 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 },   // U+0062 (b)
-    { 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 },   // U+0063 (c)
-    { 0x38, 0x30, 0x30, 0x3e, 0x33, 0x33, 0x6E, 0x00 },   // U+0064 (d)
-    { 0x00, 0x00, 0x1E, 0x33, 0x3f, 0x03, 0x1E, 0x00 },   // U+0065 (e)
-    { 0x1C, 0x36, 0x06, 0x0f, 0x06, 0x06, 0x0F, 0x00 },   // U+0066 (f)
-    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F },   // U+0067 (g)
-    { 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 },   // U+0068 (h)
-    { 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },   // U+0069 (i)
-    { 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E },   // U+006A (j)
-    { 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 },   // U+006B (k)
-    { 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },   // U+006C (l)
-    { 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 },   // U+006D (m)
-    { 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 },   // U+006E (n)
-    { 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 },   // U+006F (o)
-    { 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F },   // U+0070 (p)
-    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 },   // U+0071 (q)
-    { 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 },   // U+0072 (r)
-    { 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 },   // U+0073 (s)
-    { 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 },   // U+0074 (t)
-    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 },   // U+0075 (u)
-    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },   // U+0076 (v)
-    { 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 },   // U+0077 (w)
-    { 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 },   // U+0078 (x)
-    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F },   // U+0079 (y)
-    { 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 },   // U+007A (z)
-    { 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 },   // U+007B ({)
-    { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 },   // U+007C (|)
-    { 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 },   // U+007D (})
-    { 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // U+007E (~)
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }    // U+007F
-};
+static const uint8_t default_font[128][8] = MGL_DEFAULT_FONT;
 
 void mgl_display_write_cmd(mgl_display* display, uint8_t command) {
     if (display) {
@@ -155,12 +27,12 @@ bool mgl_display_init(mgl_display* display) {
 
     mgl_platform_i2c_init(display->i2c_baudrate, display->sda_pin, display->scl_pin);
     if (!display->framebuffer) {
-        display->framebuffer = malloc(display->width * display->height * sizeof(uint8_t));
+        display->framebuffer = malloc(mgl_display_get_framebuffer_size(display));
         if (!display->framebuffer) {
             printf("Failed to allocate framebuffer: No memory!\n");
             return false;
         }
-        memset(display->framebuffer, 0x00, display->width * display->height * sizeof(uint8_t));
+        memset(display->framebuffer, 0x00, mgl_display_get_framebuffer_size(display));
     }
     mgl_display_set_state(display, 1);
     mgl_display_render(display);
@@ -176,6 +48,35 @@ void mgl_display_destroy(mgl_display* display) {
     }
 }
 
+uint32_t mgl_display_get_framebuffer_size(mgl_display* display) {
+    if (!display) return 0;
+    // Every byte holds 8 vertical pixels (one page-column)
+    return display->width * ((display->height + 7) / 8) * sizeof(uint8_t);
+}
+
+bool mgl_surface_init(mgl_surface* surface) {
+    if (!surface) {
+        return false;
+    }
+
+    if (!surface->framebuffer) {
+        surface->framebuffer = malloc(mgl_display_get_framebuffer_size(surface));
+        if (!surface->framebuffer) {
+            printf("Failed to allocate surface: No memory!\n");
+            return false;
+        }
+        memset(surface->framebuffer, 0x00, mgl_display_get_framebuffer_size(surface));
+    }
+    return true;
+}
+
+void mgl_surface_destroy(mgl_surface* surface) {
+    if (surface && surface->framebuffer) {
+        free(surface->framebuffer);
+        surface->framebuffer = NULL;
+    }
+}
+
 void mgl_display_write_data(mgl_display* display, uint8_t data) {
     if (display) {
         uint8_t buf[2] = {0x40, data};
@@ -201,29 +102,150 @@ void mgl_display_set_state(mgl_display* display, bool enabled) {
     }
 }
 
+void mgl_display_set_inverted(mgl_display* display, bool inverted) {
+    if (!display) return;
+
+    switch (display->core)
+    {
+    case MGL_DISPLAY_CORE_SH1106: {
+        mgl_display_write_cmd(display, MGL_SH1106_SET_NORM_INV | (inverted ? 0x01 : 0x00));
+    } break;
+    default: {
+        printf("Failed to set inverted: Unknown core!\n");
+    } break;
+    }
+}
+
+void mgl_display_set_contrast(mgl_display* display, uint8_t contrast) {
+    if (!display) return;
+
+    switch (display->core)
+    {
+    case MGL_DISPLAY_CORE_SH1106: {
+        mgl_display_write_cmd(display, MGL_SH1106_SET_CONTRAST);
+        mgl_display_write_cmd(display, contrast);
+    } break;
+    default: {
+        printf("Failed to set contrast: Unknown core!\n");
+    } break;
+    }
+}
+
+void mgl_display_set_offset(mgl_display* display, uint8_t offset) {
+    if (!display) return;
+
+    switch (display->core)
+    {
+    case MGL_DISPLAY_CORE_SH1106: {
+        mgl_display_write_cmd(display, MGL_SH1106_SET_DISPLAY_OFFSET);
+        mgl_display_write_cmd(display, offset & 0x3F);
+    } break;
+    default: {
+        printf("Failed to set offset: Unknown core!\n");
+    } break;
+    }
+}
+
+static inline bool mgl_orientation_is_portrait(mgl_display_orientation orientation) {
+    return orientation == MGL_ORIENTATION_90 || orientation == MGL_ORIENTATION_270;
+}
+
+/**
+ *  Transpose an 8x8 bit matrix, bit b of byte k ends up as bit k of byte b.
+ *  (Hacker's Delight, 7-3)
+ */
+static inline uint64_t mgl_transpose8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+/**
+ *  Build the panel page "page" (columns first_column to first_column+columns-1)
+ *  of a portrait framebuffer into out.
+ *  The panel pixel px|py shows the framebuffer pixel py|(height-1-px),
+ *  every 8 framebuffer columns of a framebuffer page form one 8x8 block of the panel page.
+ */
+static void mgl_display_rotate_page(mgl_display* display, uint32_t page, uint32_t first_column, uint32_t columns, uint8_t* out) {
+    uint32_t pages = display->height / 8;
+    for (uint32_t p = 0; p < pages; ++p) {
+        // The block of framebuffer page p covers the panel columns height-8-8p to height-1-8p
+        uint32_t block_first = display->height - 8 - 8*p;
+        if (block_first + 8 <= first_column || block_first >= first_column + columns) {
+            continue;
+        }
+
+        uint64_t block = 0;
+        const uint8_t *src = &display->framebuffer[page*8 + p*display->width];
+        for (uint8_t k = 0; k < 8; ++k) {
+            block |= (uint64_t)src[k] << (8*k);
+        }
+        block = mgl_transpose8(block);
+
+        // Framebuffer row 8p+b is shown on panel column height-1-8p-b
+        for (uint8_t b = 0; b < 8; ++b) {
+            uint32_t px = block_first + 7 - b;
+            if (px >= first_column && px < first_column + columns) {
+                out[px - first_column] = block >> (8*b);
+            }
+        }
+    }
+}
+
 void mgl_display_render(mgl_display* display) {
     if (!display) return;
 
+    mgl_display_render_area(display, 0, 0, display->width, display->height);
+}
+
+void mgl_display_render_area(mgl_display* display, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    if (!display || !display->framebuffer) return;
+    // Negative coordinate check is redundant because of unsigned integers
+    if (x >= display->width || y >= display->height || width == 0 || height == 0) {
+        return;
+    }
+    if (width > display->width - x) {
+        width = display->width - x;
+    }
+    if (height > display->height - y) {
+        height = display->height - y;
+    }
+
     switch (display->core)
     {
     case MGL_DISPLAY_CORE_SH1106: {
-        uint32_t pages = floor(display->height / 8);
+        bool portrait = mgl_orientation_is_portrait(display->orientation);
+        // Area on the panel, a portrait framebuffer is rotated by 90 degrees
+        uint32_t first_page = portrait ? x / 8 : y / 8;
+        uint32_t last_page = portrait ? (x + width - 1) / 8 : (y + height - 1) / 8;
+        uint32_t first_column = portrait ? display->height - y - height : x;
+        uint32_t columns = portrait ? height : width;
+        uint32_t column = first_column + MGL_SH1106_COLUMN_OFFSET;
 
-        for (uint32_t i = 0; i < pages; ++i) {
+        uint8_t *data = calloc(columns+1, sizeof(uint8_t));
+        if (data == NULL) {
+            printf("Failed to render: No more memory!\n");
+            return;
+        }
+        data[0] = 0x40;
+        for (uint32_t i = first_page; i <= last_page; ++i) {
             mgl_display_write_cmd(display, MGL_SH1106_SET_PAGE_ADDRESS | i);
-            mgl_display_write_cmd(display, MGL_SH1106_LOW_COLUMN_ADDRESS);
-            mgl_display_write_cmd(display, MGL_SH1106_HIGH_COLUMN_ADDRESS);
-            
-            uint8_t *data = calloc(display->width+1, sizeof(uint8_t));
-            if (data == NULL) {
-                printf("Failed to render: No more memory!\n");
-                return;
+            mgl_display_write_cmd(display, column & 0x0F);
+            mgl_display_write_cmd(display, MGL_SH1106_HIGH_COLUMN_ADDRESS | (column >> 4));
+
+            if (portrait) {
+                mgl_display_rotate_page(display, i, first_column, columns, &data[1]);
+            } else {
+                memcpy(&data[1], &display->framebuffer[display->width*i + x], columns);
             }
-            data[0] = 0x40;
-            memcpy(&data[1], &display->framebuffer[display->width*i], (display->width+1));
-            mgl_platform_i2c_write_blocking(display->i2c_address, data, display->width+1);
-            free(data);
+            mgl_platform_i2c_write_blocking(display->i2c_address, data, columns+1);
         }
+        free(data);
     } break;
     default: {
         printf("Failed to render: Unknown core!\n");
@@ -231,6 +253,52 @@ void mgl_display_render(mgl_display* display) {
     }
 }
 
+bool mgl_display_set_orientation(mgl_display* display, mgl_display_orientation orientation, bool mirrored) {
+    if (!display) return false;
+
+    bool portrait = mgl_orientation_is_portrait(orientation);
+    bool swap = portrait != mgl_orientation_is_portrait(display->orientation);
+    uint32_t width = swap ? display->height : display->width;
+    uint32_t height = swap ? display->width : display->height;
+    // Portrait framebuffers are rotated in 8x8 blocks
+    if (portrait && (width % 8 || height % 8)) {
+        printf("Failed to set orientation: Dimensions must be multiples of 8!\n");
+        return false;
+    }
+
+    switch (display->core)
+    {
+    case MGL_DISPLAY_CORE_SH1106: {
+        // 180 degrees and mirroring are done by the display itself,
+        // 270 degrees is 90 degrees (rotated while rendering) flipped by the display.
+        bool seg_remap = false;
+        bool scan_reversed = false;
+        switch (orientation) {
+        case MGL_ORIENTATION_0: seg_remap = mirrored; break;
+        case MGL_ORIENTATION_90: scan_reversed = mirrored; break;
+        case MGL_ORIENTATION_180: seg_remap = !mirrored; scan_reversed = true; break;
+        case MGL_ORIENTATION_270: seg_remap = true; scan_reversed = !mirrored; break;
+        }
+        mgl_display_write_cmd(display, MGL_SH1106_SET_SEG_REMAP | (seg_remap ? 0x01 : 0x00));
+        mgl_display_write_cmd(display, MGL_SH1106_SET_SCAN_DIR | (scan_reversed ? 0x08 : 0x00));
+    } break;
+    default: {
+        printf("Failed to set orientation: Unknown core!\n");
+        return false;
+    } break;
+    }
+
+    if (swap) {
+        display->width = width;
+        display->height = height;
+        // The contents of the framebuffer have no meaning in the new layout
+        mgl_display_fill(display, 0x00);
+    }
+    display->orientation = orientation;
+    display->mirrored = mirrored;
+    return true;
+}
+
 void mgl_display_draw_pixel(mgl_display* display, uint32_t x, uint32_t y) {
     // Negative coordinate check is redundant because of unsigned integers
     if (!display || !display->framebuffer || x >= display->width || y >= display->height) {
@@ -316,7 +384,7 @@ void mgl_display_draw_rect(mgl_display* display, uint32_t x, uint32_t y, uint32_
 
 void mgl_display_fill(mgl_display* display, uint8_t value) {
     if (display && display->framebuffer) {
-        memset(display->framebuffer, value, display->width * display->height * sizeof(uint8_t));
+        memset(display->framebuffer, value, mgl_display_get_framebuffer_size(display));
     }
 }
 
@@ -348,3 +416,475 @@ void mgl_display_draw_string(mgl_display* display, uint32_t x, uint32_t y, const
         mgl_display_draw_char(display, x+(i*8), y, str[i]);
     }
 }
+
+static inline void mgl_compose_byte(uint8_t* dst, uint8_t bits, uint8_t mask, mgl_compose_mode mode) {
+    if (mode == MGL_COMPOSE_COPY) {
+        *dst = (*dst & ~mask) | (bits & mask);
+    } else {
+        *dst |= bits & mask;
+    }
+}
+
+void mgl_display_compose(mgl_display* display, mgl_surface* surface, uint32_t x, uint32_t y, mgl_compose_mode mode) {
+    if (!display || !display->framebuffer || !surface || !surface->framebuffer) {
+        return;
+    }
+    // Negative coordinate check is redundant because of unsigned integers
+    if (x >= display->width || y >= display->height) {
+        return;
+    }
+
+    // Clip the surface to the visible part of the display
+    uint32_t width = surface->width;
+    if (width > display->width - x) {
+        width = display->width - x;
+    }
+    uint32_t height = surface->height;
+    if (height > display->height - y) {
+        height = display->height - y;
+    }
+
+    uint32_t src_pages = (height + 7) / 8;
+    uint32_t dst_pages = (display->height + 7) / 8;
+    uint32_t dst_page = y / 8;
+    uint8_t shift = y % 8;
+
+    for (uint32_t p = 0; p < src_pages; ++p) {
+        uint8_t *src = &surface->framebuffer[p * surface->width];
+        uint8_t *dst = &display->framebuffer[(dst_page + p) * display->width + x];
+        // Only the last page of the surface may be partially covered
+        uint8_t mask = 0xFF;
+        if (p == src_pages - 1 && height % 8) {
+            mask = (1 << (height % 8)) - 1;
+        }
+
+        if (shift == 0) {
+            // Page aligned: every source byte maps onto exactly one destination byte
+            if (mask == 0xFF && mode == MGL_COMPOSE_COPY) {
+                memcpy(dst, src, width);
+            } else {
+                for (uint32_t i = 0; i < width; ++i) {
+                    mgl_compose_byte(&dst[i], src[i], mask, mode);
+                }
+            }
+            continue;
+        }
+
+        // Unaligned: every source byte is split across two destination pages
+        uint8_t *next = NULL;
+        if (dst_page + p + 1 < dst_pages) {
+            next = &display->framebuffer[(dst_page + p + 1) * display->width + x];
+        }
+        for (uint32_t i = 0; i < width; ++i) {
+            mgl_compose_byte(&dst[i], src[i] << shift, mask << shift, mode);
+            if (next) {
+                mgl_compose_byte(&next[i], src[i] >> (8 - shift), mask >> (8 - shift), mode);
+            }
+        }
+    }
+}
+
+/**
+ *  Draw the glyph of c into the 8x8 cell at x|y, pixels of the cell that are not part of the glyph are cleared.
+ *  The glyph is transposed into page columns, so a cell costs at most 16 byte writes.
+ */
+static void mgl_display_put_glyph(mgl_display* display, uint32_t x, uint32_t y, char c) {
+    uint32_t page = y / 8;
+    uint8_t shift = y % 8;
+    uint32_t pages = (display->height + 7) / 8;
+    const uint8_t *glyph = default_font[(uint8_t)c & 0x7F];
+
+    for (uint32_t j = 0; j < 8 && x+j < display->width; ++j) {
+        uint8_t column = 0;
+        for (uint8_t i = 0; i < 8; ++i) {
+            column |= ((glyph[i] >> j) & 1) << i;
+        }
+
+        uint8_t *dst = &display->framebuffer[x + j + page * display->width];
+        *dst = (*dst & ~(0xFF << shift)) | (column << shift);
+        if (shift && page+1 < pages) {
+            dst += display->width;
+            *dst = (*dst & ~(0xFF >> (8 - shift))) | (column >> (8 - shift));
+        }
+    }
+}
+
+/**
+ *  Write the decimal representation of value into buf,
+ *  a '.' is put in front of the last "decimals" digits.
+ *  Returns the amount of chars written, buf is not terminated.
+ */
+static uint8_t mgl_format_fixed(char* buf, int32_t value, uint8_t decimals) {
+    char digits[10];
+    uint8_t count = 0;
+    // Negating INT32_MIN does not fit into int32_t
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    // A fixed-point value always has a leading digit before the '.'
+    while (decimals && count < decimals+1 && count < sizeof(digits)) {
+        digits[count++] = '0';
+    }
+
+    uint8_t len = 0;
+    if (value < 0) {
+        buf[len++] = '-';
+    }
+    while (count > 0) {
+        if (decimals && count == decimals) {
+            buf[len++] = '.';
+        }
+        buf[len++] = digits[--count];
+    }
+    return len;
+}
+
+void mgl_text_field_init(mgl_display* display, mgl_text_field* field, uint32_t x, uint32_t y, uint8_t cells) {
+    if (!display || !display->framebuffer || !field) {
+        return;
+    }
+    if (cells > MGL_TEXT_FIELD_MAX_CELLS) {
+        cells = MGL_TEXT_FIELD_MAX_CELLS;
+    }
+
+    field->x = x;
+    field->y = y;
+    field->cells = cells;
+    field->dirty = 0;
+    for (uint8_t i = 0; i < cells; ++i) {
+        field->text[i] = ' ';
+        if (x+i*8 < display->width && y < display->height) {
+            mgl_display_put_glyph(display, x+i*8, y, ' ');
+            field->dirty |= 1u << i;
+        }
+    }
+}
+
+void mgl_text_field_set_string(mgl_display* display, mgl_text_field* field, const char* str) {
+    if (!display || !display->framebuffer || !field || !str || field->y >= display->height) {
+        return;
+    }
+
+    bool ended = false;
+    for (uint8_t i = 0; i < field->cells && field->x+i*8 < display->width; ++i) {
+        if (!str[i]) {
+            ended = true;
+        }
+        char c = ended ? ' ' : str[i];
+        // Only cells whose glyph changed are rasterized
+        if (field->text[i] != c) {
+            field->text[i] = c;
+            mgl_display_put_glyph(display, field->x+i*8, field->y, c);
+            field->dirty |= 1u << i;
+        }
+    }
+}
+
+/**
+ *  Right-align text of length len (plus suffix) in the field,
+ *  fill it with '#' if it does not fit.
+ */
+static void mgl_text_field_set_number(mgl_display* display, mgl_text_field* field, const char* text, uint8_t len, const char* suffix) {
+    if (!field) {
+        return;
+    }
+
+    uint8_t suffix_len = 0;
+    while (suffix && suffix[suffix_len] && suffix_len <= MGL_TEXT_FIELD_MAX_CELLS) {
+        suffix_len++;
+    }
+
+    char buf[MGL_TEXT_FIELD_MAX_CELLS+1];
+    uint8_t cells = field->cells;
+    if (len + suffix_len > cells) {
+        memset(buf, '#', cells);
+    } else {
+        uint8_t pad = cells - len - suffix_len;
+        memset(buf, ' ', pad);
+        memcpy(&buf[pad], text, len);
+        if (suffix_len) {
+            memcpy(&buf[pad+len], suffix, suffix_len);
+        }
+    }
+    buf[cells] = '\0';
+    mgl_text_field_set_string(display, field, buf);
+}
+
+void mgl_text_field_set_int(mgl_display* display, mgl_text_field* field, int32_t value, const char* suffix) {
+    mgl_text_field_set_fixed(display, field, value, 0, suffix);
+}
+
+void mgl_text_field_set_fixed(mgl_display* display, mgl_text_field* field, int32_t value, uint8_t decimals, const char* suffix) {
+    // Sign, 10 digits and '.'
+    char text[12];
+    if (decimals > 9) {
+        decimals = 9;
+    }
+    uint8_t len = mgl_format_fixed(text, value, decimals);
+    mgl_text_field_set_number(display, field, text, len, suffix);
+}
+
+void mgl_text_field_render(mgl_display* display, mgl_text_field* field) {
+    if (!display || !field) {
+        return;
+    }
+
+    // Adjacent dirty cells are transmitted together
+    uint8_t i = 0;
+    while (i < field->cells) {
+        if (!(field->dirty & (1u << i))) {
+            ++i;
+            continue;
+        }
+        uint8_t first = i;
+        while (i < field->cells && (field->dirty & (1u << i))) {
+            ++i;
+        }
+        mgl_display_render_area(display, field->x+first*8, field->y, (i-first)*8, 8);
+    }
+    field->dirty = 0;
+}
+
+/**
+ *  Set (or clear) the pixels from y0 to y1 (inclusive) of column x, one page at a time.
+ */
+static void mgl_display_column_span(mgl_display* display, uint32_t x, uint32_t y0, uint32_t y1, bool set) {
+    for (uint32_t page = y0 / 8; page <= y1 / 8; ++page) {
+        uint32_t first = page == y0 / 8 ? y0 % 8 : 0;
+        uint32_t last = page == y1 / 8 ? y1 % 8 : 7;
+        uint8_t mask = (0xFF << first) & (0xFF >> (7 - last));
+        uint8_t *dst = &display->framebuffer[x + page * display->width];
+        *dst = set ? (*dst | mask) : (*dst & ~mask);
+    }
+}
+
+static uint32_t mgl_strip_chart_row(mgl_strip_chart* chart, int32_t value) {
+    if (value < chart->min) value = chart->min;
+    if (value > chart->max) value = chart->max;
+    // Larger values are drawn further up
+    int64_t range = (int64_t)chart->max - chart->min;
+    int64_t offset = range ? ((int64_t)value - chart->min) * (chart->height - 1) / range : 0;
+    return chart->y + chart->height - 1 - (uint32_t)offset;
+}
+
+/**
+ *  Draw the sample at index (of the ring) into column x, connected to the sample before it.
+ */
+static void mgl_strip_chart_draw_sample(mgl_display* display, mgl_strip_chart* chart, uint32_t x, uint32_t index, bool connect) {
+    uint32_t row = mgl_strip_chart_row(chart, chart->samples[index]);
+    uint32_t from = row;
+    if (connect) {
+        from = mgl_strip_chart_row(chart, chart->samples[(index + chart->width - 1) % chart->width]);
+    }
+    if (from < row) {
+        mgl_display_column_span(display, x, from, row, true);
+    } else {
+        mgl_display_column_span(display, x, row, from, true);
+    }
+}
+
+bool mgl_strip_chart_init(mgl_display* display, mgl_strip_chart* chart) {
+    if (!display || !display->framebuffer || !chart) {
+        return false;
+    }
+    // Negative coordinate check is redundant because of unsigned integers
+    if (chart->width == 0
+        || chart->height == 0
+        || chart->x >= display->width
+        || chart->y >= display->height
+        || chart->width > display->width - chart->x
+        || chart->height > display->height - chart->y
+        || chart->min >= chart->max) {
+        printf("Failed to init strip chart: Invalid area or range!\n");
+        return false;
+    }
+
+    if (!chart->samples) {
+        chart->samples = malloc(chart->width * sizeof(int32_t));
+        if (!chart->samples) {
+            printf("Failed to allocate strip chart samples: No memory!\n");
+            return false;
+        }
+    }
+    chart->head = 0;
+    chart->count = 0;
+    for (uint32_t i = 0; i < chart->width; ++i) {
+        mgl_display_column_span(display, chart->x+i, chart->y, chart->y+chart->height-1, false);
+    }
+    return true;
+}
+
+void mgl_strip_chart_destroy(mgl_strip_chart* chart) {
+    if (chart && chart->samples) {
+        free(chart->samples);
+        chart->samples = NULL;
+    }
+}
+
+void mgl_strip_chart_push(mgl_display* display, mgl_strip_chart* chart, int32_t value) {
+    if (!display || !display->framebuffer || !chart || !chart->samples) {
+        return;
+    }
+
+    uint32_t index = chart->head;
+    chart->samples[index] = value;
+    chart->head = (chart->head + 1) % chart->width;
+    if (chart->count < chart->width) {
+        chart->count++;
+    }
+
+    // Scroll the chart one column to the left, page by page
+    uint32_t top = chart->y;
+    uint32_t bottom = chart->y + chart->height - 1;
+    uint32_t last = chart->x + chart->width - 1;
+    for (uint32_t page = top / 8; page <= bottom / 8; ++page) {
+        uint8_t *row = &display->framebuffer[chart->x + page * display->width];
+        uint32_t first_bit = page == top / 8 ? top % 8 : 0;
+        uint32_t last_bit = page == bottom / 8 ? bottom % 8 : 7;
+        uint8_t mask = (0xFF << first_bit) & (0xFF >> (7 - last_bit));
+        if (mask == 0xFF) {
+            memmove(row, row + 1, chart->width - 1);
+        } else {
+            // The page is shared with pixels outside of the chart
+            for (uint32_t i = 0; i+1 < chart->width; ++i) {
+                row[i] = (row[i] & ~mask) | (row[i+1] & mask);
+            }
+        }
+    }
+
+    // Only the new column is rasterized
+    mgl_display_column_span(display, last, top, bottom, false);
+    mgl_strip_chart_draw_sample(display, chart, last, index, chart->count > 1);
+}
+
+void mgl_strip_chart_redraw(mgl_display* display, mgl_strip_chart* chart) {
+    if (!display || !display->framebuffer || !chart || !chart->samples) {
+        return;
+    }
+
+    uint32_t first_x = chart->x + chart->width - chart->count;
+    uint32_t oldest = (chart->head + chart->width - chart->count) % chart->width;
+    for (uint32_t i = 0; i < chart->width; ++i) {
+        mgl_display_column_span(display, chart->x+i, chart->y, chart->y+chart->height-1, false);
+    }
+    for (uint32_t i = 0; i < chart->count; ++i) {
+        mgl_strip_chart_draw_sample(display, chart, first_x+i, (oldest+i) % chart->width, i > 0);
+    }
+}
+
+void mgl_strip_chart_render(mgl_display* display, mgl_strip_chart* chart) {
+    if (!chart) {
+        return;
+    }
+    mgl_display_render_area(display, chart->x, chart->y, chart->width, chart->height);
+}
+
+bool mgl_effects_schedule(mgl_effects* effects, uint32_t due_ms, uint32_t period_ms, mgl_effect_action action, uint8_t value) {
+    if (!effects || effects->count >= MGL_EFFECTS_MAX_COMMANDS) {
+        return false;
+    }
+    effects->commands[effects->count++] = (mgl_effect_command){
+        .due_ms = due_ms,
+        .period_ms = period_ms,
+        .action = action,
+        .value = value
+    };
+    return true;
+}
+
+static bool mgl_effects_reserve(mgl_effects* effects, uint32_t amount) {
+    if (!effects || (uint32_t)(MGL_EFFECTS_MAX_COMMANDS - effects->count) < amount) {
+        printf("Failed to schedule effect: Too many commands!\n");
+        return false;
+    }
+    return true;
+}
+
+uint32_t mgl_effects_update(mgl_display* display, mgl_effects* effects, uint32_t now_ms) {
+    if (!display || !effects) {
+        return 0;
+    }
+
+    uint32_t sent = 0;
+    while (true) {
+        // Dispatch due commands oldest first, the signed difference handles wrapping time
+        int32_t latest = -1;
+        uint8_t index = 0;
+        for (uint8_t i = 0; i < effects->count; ++i) {
+            int32_t lateness = (int32_t)(now_ms - effects->commands[i].due_ms);
+            if (lateness > latest) {
+                latest = lateness;
+                index = i;
+            }
+        }
+        if (latest < 0) {
+            break;
+        }
+
+        mgl_effect_command* command = &effects->commands[index];
+        switch (command->action) {
+        case MGL_EFFECT_STATE: mgl_display_set_state(display, command->value); break;
+        case MGL_EFFECT_INVERT: mgl_display_set_inverted(display, command->value); break;
+        case MGL_EFFECT_CONTRAST: mgl_display_set_contrast(display, command->value); break;
+        case MGL_EFFECT_OFFSET: mgl_display_set_offset(display, command->value); break;
+        }
+        sent++;
+
+        if (command->period_ms) {
+            // Periods that were missed entirely are skipped
+            do {
+                command->due_ms += command->period_ms;
+            } while ((int32_t)(now_ms - command->due_ms) >= 0);
+        } else {
+            effects->commands[index] = effects->commands[--effects->count];
+        }
+    }
+    return sent;
+}
+
+void mgl_effects_stop(mgl_display* display, mgl_effects* effects) {
+    if (!effects) {
+        return;
+    }
+    effects->count = 0;
+    mgl_display_set_state(display, true);
+    mgl_display_set_inverted(display, false);
+    mgl_display_set_offset(display, 0);
+}
+
+bool mgl_effects_blink(mgl_effects* effects, uint32_t now_ms, uint32_t interval_ms, bool invert) {
+    if (interval_ms == 0 || !mgl_effects_reserve(effects, 2)) {
+        return false;
+    }
+    // Two commands with the same period, half a period apart
+    mgl_effect_action action = invert ? MGL_EFFECT_INVERT : MGL_EFFECT_STATE;
+    mgl_effects_schedule(effects, now_ms, 2*interval_ms, action, invert ? 1 : 0);
+    mgl_effects_schedule(effects, now_ms + interval_ms, 2*interval_ms, action, invert ? 0 : 1);
+    return true;
+}
+
+bool mgl_effects_fade(mgl_effects* effects, uint32_t now_ms, uint8_t from, uint8_t to, uint32_t duration_ms, uint8_t steps) {
+    if (steps == 0 || !mgl_effects_reserve(effects, steps)) {
+        return false;
+    }
+    for (uint8_t i = 1; i <= steps; ++i) {
+        int32_t contrast = from + ((int32_t)to - from) * i / steps;
+        mgl_effects_schedule(effects, now_ms + duration_ms * i / steps, 0, MGL_EFFECT_CONTRAST, contrast);
+    }
+    return true;
+}
+
+bool mgl_effects_shake(mgl_effects* effects, uint32_t now_ms, uint8_t amplitude, uint32_t interval_ms, uint8_t count) {
+    if (count == 0 || amplitude == 0 || amplitude >= 32 || !mgl_effects_reserve(effects, count+1)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        // The offset wraps around, 64-amplitude moves the image up
+        uint8_t offset = i % 2 ? 64 - amplitude : amplitude;
+        mgl_effects_schedule(effects, now_ms + i*interval_ms, 0, MGL_EFFECT_OFFSET, offset);
+    }
+    mgl_effects_schedule(effects, now_ms + count*interval_ms, 0, MGL_EFFECT_OFFSET, 0);
+    return true;
+}
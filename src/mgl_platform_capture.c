@@ -0,0 +1,130 @@
+/**
+ *  mgl_platform_capture.c
+ *  @brief "capture" records every i2c transaction into a trace file instead of
+ *         talking to an actual device (Linux only).
+ *         The trace (see mgl_trace.h) is a memory-mapped ring, so recording costs
+ *         a memcpy per transaction and the file stays valid even if the program crashes.
+ *         Use mgl-replay to analyze the trace.
+ *
+ *         The trace is written to $MGL_CAPTURE_FILE (default: mgl_capture.trace).
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "mgl_platform.h"
+#include "mgl_trace.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef MGL_CAPTURE_CAPACITY
+#define MGL_CAPTURE_CAPACITY (1024 * 1024)
+#endif
+
+static mgl_trace_header *trace = NULL;
+static uint8_t *ring = NULL;
+static uint64_t start_us = 0;
+
+static uint64_t mgl_capture_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static bool mgl_capture_open(void) {
+    const char *path = getenv("MGL_CAPTURE_FILE");
+    if (!path) {
+        path = "mgl_capture.trace";
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("Failed to open capture file '%s'!\n", path);
+        return false;
+    }
+    size_t size = sizeof(mgl_trace_header) + MGL_CAPTURE_CAPACITY;
+    if (ftruncate(fd, size) != 0) {
+        printf("Failed to resize capture file '%s'!\n", path);
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping stays valid after closing the file
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("Failed to map capture file '%s'!\n", path);
+        return false;
+    }
+
+    trace = map;
+    ring = (uint8_t *)map + sizeof(mgl_trace_header);
+    memcpy(trace->magic, MGL_TRACE_MAGIC, 4);
+    trace->version = MGL_TRACE_VERSION;
+    trace->capacity = MGL_CAPTURE_CAPACITY;
+    start_us = mgl_capture_now_us();
+    return true;
+}
+
+static void mgl_capture_ring_write(uint64_t pos, const void *data, uint64_t len) {
+    uint64_t offset = pos % trace->capacity;
+    uint64_t first = trace->capacity - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&ring[offset], data, first);
+    memcpy(ring, (const uint8_t *)data + first, len - first);
+}
+
+static void mgl_capture_ring_read(uint64_t pos, void *data, uint64_t len) {
+    uint64_t offset = pos % trace->capacity;
+    uint64_t first = trace->capacity - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(data, &ring[offset], first);
+    memcpy((uint8_t *)data + first, ring, len - first);
+}
+
+void mgl_platform_i2c_init(uint32_t baudrate, uint8_t sda_pin, uint8_t scl_pin) {
+    (void)sda_pin;
+    (void)scl_pin;
+    if (!trace && !mgl_capture_open()) {
+        return;
+    }
+    trace->baudrate = baudrate;
+}
+
+void mgl_platform_i2c_write_blocking(uint8_t addr, uint8_t *data, uint64_t len) {
+    if (!trace && !mgl_capture_open()) {
+        return;
+    }
+
+    uint64_t size = sizeof(mgl_trace_record) + len;
+    if (len > UINT16_MAX || size > trace->capacity) {
+        trace->dropped++;
+        return;
+    }
+
+    // Make room by dropping the oldest records
+    while (trace->head + size - trace->tail > trace->capacity) {
+        mgl_trace_record oldest;
+        mgl_capture_ring_read(trace->tail, &oldest, sizeof(oldest));
+        trace->tail += sizeof(mgl_trace_record) + oldest.length;
+        trace->dropped++;
+    }
+
+    mgl_trace_record record = {
+        .timestamp_us = (uint32_t)(mgl_capture_now_us() - start_us),
+        .length = (uint16_t)len,
+        .addr = addr,
+        .reserved = 0
+    };
+    mgl_capture_ring_write(trace->head, &record, sizeof(record));
+    mgl_capture_ring_write(trace->head + sizeof(record), data, len);
+    // Publish the record only after it was written completely
+    trace->head += size;
+}
@@ -0,0 +1,321 @@
+/**
+ *  mgl-replay.c
+ *  @brief Replay an i2c trace recorded by the "capture" platform against a simulated sh1106.
+ *         Reports bus occupancy and a histogram of transaction sizes,
+ *         optionally writes every reconstructed frame as PBM image.
+ *
+ *  Usage: mgl-replay [-b baudrate] [-g gap_us] [-o prefix] trace
+ *      -b  baudrate used to compute bus occupancy (default: the one stored in the trace or 400000)
+ *      -g  idle time (in microseconds) that separates two frames (default: 2000)
+ *      -o  write frames to <prefix>-NNNN.pbm
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "mgl_trace.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Geometry of the simulated sh1106
+#define SH1106_COLUMNS 132
+#define SH1106_PAGES 8
+#define SH1106_VISIBLE_WIDTH 128
+#define SH1106_VISIBLE_HEIGHT 64
+#define SH1106_COLUMN_OFFSET 2
+
+#define HISTOGRAM_BUCKETS 17
+
+typedef struct _sh1106_ {
+    uint8_t ram[SH1106_PAGES][SH1106_COLUMNS];
+    uint8_t page;
+    uint8_t column;
+    uint8_t start_line;
+    uint8_t offset;
+    uint8_t contrast;
+    bool enabled;
+    bool inverted;
+    bool seg_remap;
+    bool scan_reversed;
+    // Command that is waiting for its argument (0 if none)
+    uint8_t pending;
+} sh1106;
+
+typedef struct _replay_ {
+    sh1106 panel;
+    const char *prefix;
+    uint32_t gap_us;
+
+    // Frame detection
+    bool dirty;
+    uint8_t last_page;
+    uint8_t last_column;
+    uint32_t frames;
+
+    // Statistics
+    uint64_t transactions;
+    uint64_t bytes;
+    uint64_t commands;
+    uint64_t busy_bits;
+    uint64_t histogram[HISTOGRAM_BUCKETS];
+} replay;
+
+static void sh1106_command(sh1106 *panel, uint8_t cmd, bool *visible) {
+    if (panel->pending) {
+        switch (panel->pending) {
+        case 0x81: panel->contrast = cmd; break;
+        case 0xd3: panel->offset = cmd % SH1106_VISIBLE_HEIGHT; *visible = true; break;
+        default: break;
+        }
+        panel->pending = 0;
+        return;
+    }
+
+    if (cmd <= 0x0f) {
+        panel->column = (panel->column & 0xf0) | cmd;
+    } else if (cmd <= 0x1f) {
+        panel->column = (panel->column & 0x0f) | ((cmd & 0x0f) << 4);
+    } else if (cmd >= 0x40 && cmd <= 0x7f) {
+        panel->start_line = cmd & 0x3f;
+        *visible = true;
+    } else if (cmd == 0xa0 || cmd == 0xa1) {
+        panel->seg_remap = cmd & 0x01;
+        *visible = true;
+    } else if (cmd == 0xa6 || cmd == 0xa7) {
+        panel->inverted = cmd & 0x01;
+        *visible = true;
+    } else if (cmd == 0xae || cmd == 0xaf) {
+        panel->enabled = cmd & 0x01;
+        *visible = true;
+    } else if (cmd >= 0xb0 && cmd <= 0xb7) {
+        panel->page = cmd & 0x07;
+    } else if (cmd == 0xc0 || cmd == 0xc8) {
+        panel->scan_reversed = cmd & 0x08;
+        *visible = true;
+    } else if (cmd == 0x81 || cmd == 0xa8 || cmd == 0xad || cmd == 0xd3
+               || cmd == 0xd5 || cmd == 0xd9 || cmd == 0xda || cmd == 0xdb) {
+        // Double byte commands
+        panel->pending = cmd;
+    }
+}
+
+static bool sh1106_pixel(const sh1106 *panel, uint32_t x, uint32_t y) {
+    if (!panel->enabled) {
+        return false;
+    }
+    uint32_t com = panel->scan_reversed ? SH1106_VISIBLE_HEIGHT - 1 - y : y;
+    uint32_t row = (panel->start_line + com + panel->offset) % SH1106_VISIBLE_HEIGHT;
+    uint32_t column = x + SH1106_COLUMN_OFFSET;
+    if (panel->seg_remap) {
+        column = SH1106_COLUMNS - 1 - column;
+    }
+    bool set = (panel->ram[row / 8][column] >> (row % 8)) & 1;
+    return set != panel->inverted;
+}
+
+static void replay_emit_frame(replay *r) {
+    if (!r->dirty) {
+        return;
+    }
+    r->dirty = false;
+    uint32_t index = r->frames++;
+    if (!r->prefix) {
+        return;
+    }
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s-%04u.pbm", r->prefix, index);
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "Failed to write frame '%s'!\n", path);
+        return;
+    }
+    // Set pixels are written as 1 (black)
+    fprintf(f, "P4\n%d %d\n", SH1106_VISIBLE_WIDTH, SH1106_VISIBLE_HEIGHT);
+    for (uint32_t y = 0; y < SH1106_VISIBLE_HEIGHT; ++y) {
+        uint8_t row[SH1106_VISIBLE_WIDTH / 8] = {0};
+        for (uint32_t x = 0; x < SH1106_VISIBLE_WIDTH; ++x) {
+            if (sh1106_pixel(&r->panel, x, y)) {
+                row[x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+    fclose(f);
+}
+
+static void replay_data(replay *r, uint8_t data) {
+    sh1106 *panel = &r->panel;
+    // Going back to an earlier position means a new frame has started
+    if (panel->page < r->last_page
+        || (panel->page == r->last_page && panel->column < r->last_column)) {
+        replay_emit_frame(r);
+    }
+    if (panel->column < SH1106_COLUMNS) {
+        panel->ram[panel->page][panel->column++] = data;
+    }
+    r->last_page = panel->page;
+    r->last_column = panel->column;
+    r->dirty = true;
+}
+
+static void replay_transaction(replay *r, const uint8_t *data, uint16_t len) {
+    bool visible = false;
+    uint16_t i = 0;
+    while (i < len) {
+        uint8_t control = data[i++];
+        bool single = control & 0x80;
+        bool is_data = control & 0x40;
+        // Co = 1: one byte follows, Co = 0: the rest of the transaction follows
+        uint16_t end = single ? i + 1 : len;
+        if (end > len) {
+            end = len;
+        }
+        for (; i < end; ++i) {
+            if (is_data) {
+                replay_data(r, data[i]);
+            } else {
+                sh1106_command(&r->panel, data[i], &visible);
+                r->commands++;
+            }
+        }
+    }
+    if (visible) {
+        r->dirty = true;
+    }
+}
+
+static uint8_t histogram_bucket(uint16_t len) {
+    uint8_t bucket = 0;
+    while (bucket < HISTOGRAM_BUCKETS - 1 && (1u << bucket) < len) {
+        bucket++;
+    }
+    return bucket;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-b baudrate] [-g gap_us] [-o prefix] trace\n", name);
+}
+
+int main(int argc, char **argv) {
+    uint32_t baudrate = 0;
+    replay r;
+    memset(&r, 0, sizeof(r));
+    r.gap_us = 2000;
+    r.panel.contrast = 0x80;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:g:o:h")) != -1) {
+        switch (opt) {
+        case 'b': baudrate = strtoul(optarg, NULL, 10); break;
+        case 'g': r.gap_us = strtoul(optarg, NULL, 10); break;
+        case 'o': r.prefix = optarg; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *f = fopen(argv[optind], "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open trace '%s'!\n", argv[optind]);
+        return 1;
+    }
+    mgl_trace_header header;
+    if (fread(&header, sizeof(header), 1, f) != 1
+        || memcmp(header.magic, MGL_TRACE_MAGIC, 4) != 0
+        || header.version != MGL_TRACE_VERSION
+        || header.capacity == 0
+        || header.head - header.tail > header.capacity) {
+        fprintf(stderr, "'%s' is not a valid trace!\n", argv[optind]);
+        fclose(f);
+        return 1;
+    }
+    uint8_t *ring = malloc(header.capacity);
+    if (!ring) {
+        fprintf(stderr, "Failed to read trace: No memory!\n");
+        fclose(f);
+        return 1;
+    }
+    if (fread(ring, 1, header.capacity, f) != header.capacity) {
+        fprintf(stderr, "Failed to read trace: File is truncated!\n");
+        free(ring);
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    if (baudrate == 0) {
+        baudrate = header.baudrate ? header.baudrate : 400000;
+    }
+
+    // Timestamps are 32 bit, unwrap them into 64 bit
+    uint64_t first_ns = 0;
+    uint64_t last_us = 0;
+    uint64_t last_end_ns = 0;
+    uint32_t previous = 0;
+    uint64_t epoch = 0;
+
+    uint8_t data[UINT16_MAX];
+    uint64_t pos = header.tail;
+    while (pos < header.head) {
+        mgl_trace_record record;
+        for (uint64_t i = 0; i < sizeof(record); ++i) {
+            ((uint8_t *)&record)[i] = ring[(pos + i) % header.capacity];
+        }
+        pos += sizeof(record);
+        for (uint64_t i = 0; i < record.length; ++i) {
+            data[i] = ring[(pos + i) % header.capacity];
+        }
+        pos += record.length;
+
+        if (r.transactions > 0 && record.timestamp_us < previous) {
+            epoch += (uint64_t)1 << 32;
+        }
+        previous = record.timestamp_us;
+        uint64_t now_us = epoch + record.timestamp_us;
+        if (r.transactions == 0) {
+            first_ns = now_us * 1000;
+        } else if (now_us - last_us > r.gap_us) {
+            replay_emit_frame(&r);
+        }
+        last_us = now_us;
+
+        // Start + address byte + data bytes (each with ACK) + stop
+        uint64_t bits = 1 + (1 + (uint64_t)record.length) * 9 + 1;
+        r.busy_bits += bits;
+        // A transaction can not start before the previous one is off the bus
+        uint64_t start_ns = now_us * 1000 > last_end_ns ? now_us * 1000 : last_end_ns;
+        last_end_ns = start_ns + bits * 1000000000 / baudrate;
+
+        r.transactions++;
+        r.bytes += record.length;
+        r.histogram[histogram_bucket(record.length)]++;
+        replay_transaction(&r, data, record.length);
+    }
+    replay_emit_frame(&r);
+    free(ring);
+
+    double duration_ms = (last_end_ns - first_ns) / 1000000.0;
+    double busy_ms = r.busy_bits * 1000.0 / baudrate;
+    printf("transactions: %llu (%llu dropped)\n",
+           (unsigned long long)r.transactions, (unsigned long long)header.dropped);
+    printf("bytes:        %llu (%llu commands)\n",
+           (unsigned long long)r.bytes, (unsigned long long)r.commands);
+    printf("duration:     %.3f ms\n", duration_ms);
+    printf("bus busy:     %.3f ms at %u baud (%.1f%%)\n",
+           busy_ms, baudrate, duration_ms > 0 ? 100.0 * busy_ms / duration_ms : 100.0);
+    printf("frames:       %u\n", r.frames);
+    printf("transaction sizes:\n");
+    for (uint8_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        if (r.histogram[i]) {
+            uint32_t low = i == 0 ? 0 : (1u << (i - 1)) + 1;
+            printf("  %6u - %-6u %llu\n", low, 1u << i, (unsigned long long)r.histogram[i]);
+        }
+    }
+    return 0;
+}